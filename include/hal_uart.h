@@ -41,6 +41,38 @@
 #define UART_P1 ((HAL_UART_Type *)UART_1_BASE_ADDRESS)
 
 #define TIMEOUT_TICKS 100000
+// Предельное ожидание собеседника, снявшего CTS, в шагах цикла ожидания.
+#define CTS_TIMEOUT_TICKS (TIMEOUT_TICKS * 100)
+
+/**
+ * Возвращает значение счётчика тактов ядра (mcycle). Используется для точных интервалов и замеров задержек.
+ */
+static inline uint32_t HAL_UART_Cycles(void)
+{
+    uint32_t c;
+    __asm__ volatile("csrr %0, mcycle" : "=r"(c));
+    return c;
+}
+
+/**
+ * Запрещает прерывания ядра (mstatus.MIE) и возвращает прежнее значение mstatus для HAL_UART_IrqRestore.
+ * Нужна там, где основной цикл и обработчик прерывания изменяют одни и те же регистры или поля.
+ */
+static inline uint32_t HAL_UART_IrqSave(void)
+{
+    uint32_t s;
+    __asm__ volatile("csrrci %0, mstatus, 8" : "=r"(s) : : "memory");
+    return s;
+}
+
+/**
+ * Разрешает прерывания ядра, если они были разрешены до HAL_UART_IrqSave.
+ */
+static inline void HAL_UART_IrqRestore(uint32_t s)
+{
+    if (s & 8)
+        __asm__ volatile("csrsi mstatus, 8" : : : "memory");
+}
 
 typedef struct
 {
@@ -96,6 +128,49 @@ void HAL_UART_EnableQuick(HAL_UART_Type *dev, uint32_t baseFreq, uint32_t bod);
  * \param init Данные для инициализации.
  */
 void HAL_UART_Enable(HAL_UART_Type *dev, UART_InitData* init);
+/**
+ * Включает устройство в синхронном режиме ведущего (выход тактирования CK), 1 стоп-бит.
+ * Делитель, как и в асинхронном режиме, не может быть меньше 16 (не быстрее baseFreq / 16).
+ * Вернёт 1, если частота недопустима, устройство при этом не трогается.
+ *
+ * \param dev Дескриптор устройства.
+ * \param baseFreq Базовая частота (обычно 32_000_000).
+ * \param bod Частота тактирования в герцах. Будет округлена в большую сторону.
+ * \param frameLength Одно из значений FRAME_7BITS, FRAME_8BITS, FRAME_9BITS. Для FRAME_9BITS используется HAL_UART_Transfer16.
+ * \param clock Параметры тактирования. Поле enabled выставляется автоматически.
+ */
+uint8_t HAL_UART_EnableSync(HAL_UART_Type *dev, uint32_t baseFreq, uint32_t bod, uint8_t frameLength, UsartClockSetup clock);
+/**
+ * Меняет скорость и формат кадра (длина, чётность, стоп-биты) работающего устройства без полного сброса.
+ * Дожидается окончания текущей передачи и текущего приёма (BUSY), сохраняет остальные настройки и прерывания.
+ * Кадр, принятый до переключения, возвращается через pending; кадры, пришедшие во время переключения, отбрасываются.
+ * Возвращает 1, если передача или приём не завершились или устройство не вернулось в работу.
+ *
+ * \param dev Дескриптор устройства.
+ * \param init Новые настройки. Используются только baseFreq, bod, frameLength, parityBit, stopType.
+ * \param pending Кадр, ожидавший чтения до переключения, или -1, если его не было. Может быть NULL, тогда кадр теряется.
+ */
+uint8_t HAL_UART_Reconfigure(HAL_UART_Type *dev, UART_InitData *init, int *pending);
+/**
+ * Меняет только скорость работающего устройства. Аналогично HAL_UART_Reconfigure.
+ * Возвращает 1, если передача или приём не завершились или устройство не вернулось в работу.
+ *
+ * \param dev Дескриптор устройства.
+ * \param baseFreq Базовая частота (обычно 32_000_000).
+ * \param bod Скорость интерфейса в бодах.
+ * \param pending Кадр, ожидавший чтения до переключения, или -1, если его не было. Может быть NULL.
+ */
+uint8_t HAL_UART_SetBaud(HAL_UART_Type *dev, uint32_t baseFreq, uint32_t bod, int *pending);
+/**
+ * Включает или выключает аппаратное управление потоком работающего устройства. CTSE/RTSE записываются
+ * только при снятом UE, поэтому модуль перезапускается после окончания текущей передачи.
+ * Возвращает 1, если передача не завершилась или устройство не вернулось в работу.
+ *
+ * \param dev Дескриптор устройства.
+ * \param cts true для включения CTS.
+ * \param rts true для включения RTS.
+ */
+uint8_t HAL_UART_SetFlowControl(HAL_UART_Type *dev, bool cts, bool rts);
 /**
  * Выключает устройство.
  *
@@ -111,6 +186,7 @@ void HAL_UART_Reset(HAL_UART_Type *dev);
 
 /**
  * Отправляет один кадр (7-9 бит). Старшие биты игнорируются. Возвращает 1, если отправка не была успешно завершена.
+ * При включенном CTSE время, пока собеседник не готов принимать, ограничено отдельно, CTS_TIMEOUT_TICKS.
  *
  * \param dev Дескриптор устройства.
  * \param val Байт/слово для отправки.
@@ -140,6 +216,52 @@ uint8_t HAL_UART_Send16(HAL_UART_Type *dev, uint16_t *buffer, unsigned count);
  */
 uint8_t HAL_UART_SendNT(HAL_UART_Type *dev, char *string);
 
+/**
+ * Одновременно отправляет и принимает буфер данных (7-8 бит на кадр). Передача идёт потоком по TXE/RXNE,
+ * без ожидания TC между кадрами. Предназначено для синхронного режима. Возвращает 1, если обмен не был успешно завершён.
+ *
+ * \param dev Дескриптор устройства.
+ * \param tx Буфер для отправки. Если NULL, отправляется 0xFF.
+ * \param rx Буфер для приёма. Если NULL, принятые данные отбрасываются.
+ * \param count Длина буферов.
+ */
+uint8_t HAL_UART_Transfer8(HAL_UART_Type *dev, uint8_t *tx, uint8_t *rx, unsigned count);
+/**
+ * Одновременно отправляет и принимает буфер данных (9 бит на кадр, старшие биты игнорируются). Возвращает 1, если обмен не был успешно завершён.
+ *
+ * \param dev Дескриптор устройства.
+ * \param tx Буфер для отправки. Если NULL, отправляется 0x1FF.
+ * \param rx Буфер для приёма. Если NULL, принятые данные отбрасываются.
+ * \param count Длина буферов.
+ */
+uint8_t HAL_UART_Transfer16(HAL_UART_Type *dev, uint16_t *tx, uint16_t *rx, unsigned count);
+/**
+ * Включает запросы DMA от передатчика и/или приёмника. Канал DMA настраивается отдельно
+ * на адреса &dev->TXDATA и &dev->RXDATA.
+ *
+ * \param dev Дескриптор устройства.
+ * \param tx true для запросов по TXE.
+ * \param rx true для запросов по RXNE.
+ */
+void HAL_UART_SetDma(HAL_UART_Type *dev, bool tx, bool rx);
+
+/**
+ * Отправляет сигнал BREAK средствами модуля (SBKRQ): нули на длину кадра, около 10 бит при 8N1.
+ * Возвращает 1, если отправка не была успешно завершена.
+ *
+ * \param dev Дескриптор устройства.
+ */
+uint8_t HAL_UART_SendBreak(HAL_UART_Type *dev);
+/**
+ * Отправляет BREAK длиной не меньше указанного количества бит (например, 13 для LIN): кадр 0x00 на временно
+ * уменьшенной скорости. Стоп-бит этого кадра служит разделителем. Перед возвратом скорость восстанавливается.
+ * Возвращает 1, если отправка не была успешно завершена.
+ *
+ * \param dev Дескриптор устройства.
+ * \param bits Минимальная длина BREAK в битах на текущей скорости.
+ */
+uint8_t HAL_UART_SendBreakBits(HAL_UART_Type *dev, unsigned bits);
+
 /**
  * Проверяет, доступны ли данные для чтения. Вернёт 0, если читать нечего, 1 если кадр ждёт принятия.
  *
@@ -226,7 +348,8 @@ int HAL_UART_ReceiveAsciiInt(HAL_UART_Type *dev, uint8_t breakChar, bool echo);
 */
 uint8_t HAL_UART_SendAsciiInt(HAL_UART_Type *dev, int num);
 
-#define HAL_UART_SetDtr(dev, ready) dev->MODEM.DTR = ready & 1;
+// Запись без битов *IF: чтение-изменение-запись битового поля сбросило бы защёлкнутые события модема.
+#define HAL_UART_SetDtr(dev, ready) ((dev)->MODEM.value = ((ready) & 1) ? UART_MODEM_DTR_M : 0)
 #define HAL_UART_GetDsr(dev) (dev->MODEM.DSR)
 
 #endif
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef _HAL_UART_BAUD
+#define _HAL_UART_BAUD
+
+#include <hal_uart.h>
+
+// Скорость, с которой начинается согласование.
+#define NEGOTIATE_START_BOD 115200
+// Длина проверочной посылки на новой скорости.
+#define NEGOTIATE_BURST 64
+// Пауза перед проверочной посылкой, чтобы подчинённый успел переключиться (1 мс при 32 МГц).
+#define NEGOTIATE_SETTLE_CYCLES 32000
+
+/**
+ * Согласует скорость со стороны ведущего. Перебирает скорости из списка по порядку (от большей к меньшей),
+ * для каждой предлагает её подчинённому, переключается, отправляет подряд NEGOTIATE_BURST байт и сравнивает
+ * возвращённый подчинённым блок. Переход закрепляется на новой скорости тройным рукопожатием: ведущий отправляет
+ * COMMIT (повторяя его, если ответ потерялся), подчинённый отвечает ACK, ведущий подтверждает получение CONFIRM.
+ * При ошибке или без ACK ведущий возвращается на startBod; подчинённый, не дождавшись CONFIRM, тоже.
+ * Рассогласование остаётся возможным только при потере самого CONFIRM.
+ * Вернёт согласованную скорость (startBod, если ни одна не подошла).
+ *
+ * \param dev Дескриптор устройства, включенного на скорости startBod.
+ * \param baseFreq Базовая частота (обычно 32_000_000).
+ * \param startBod Начальная скорость, обычно NEGOTIATE_START_BOD.
+ * \param rates Предлагаемые скорости.
+ * \param count Длина списка.
+ */
+uint32_t HAL_UART_NegotiateMaster(HAL_UART_Type *dev, uint32_t baseFreq, uint32_t startBod, const uint32_t *rates, unsigned count);
+/**
+ * Согласует скорость со стороны подчинённого. Блокируется до окончания согласования ведущим.
+ * Соглашается только на скорости из своего списка. Новая скорость закрепляется только после CONFIRM от ведущего,
+ * без него (тишина или посторонние байты) подчинённый возвращается на startBod и ждёт следующего предложения.
+ * Вернёт согласованную скорость (startBod, если ни одна не подошла).
+ *
+ * \param dev Дескриптор устройства, включенного на скорости startBod.
+ * \param baseFreq Базовая частота (обычно 32_000_000).
+ * \param startBod Начальная скорость, обычно NEGOTIATE_START_BOD.
+ * \param rates Поддерживаемые скорости.
+ * \param count Длина списка.
+ */
+uint32_t HAL_UART_NegotiateSlave(HAL_UART_Type *dev, uint32_t baseFreq, uint32_t startBod, const uint32_t *rates, unsigned count);
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef _HAL_UART_LATENCY
+#define _HAL_UART_LATENCY
+
+#include <inttypes.h>
+
+// Количество корзин на каждую степень двойки (логарифмически-линейная гистограмма), 2^LATENCY_SUB_BITS.
+#define LATENCY_SUB_BITS 3
+// Количество корзин гистограммы задержек. Задержки меньше 2^(LATENCY_SUB_BITS + 1) учитываются точно,
+// каждый следующий интервал [2^k, 2^(k+1)) делится на 2^LATENCY_SUB_BITS равных корзин. Покрывает весь uint32_t.
+#define LATENCY_BUCKETS ((32 - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS)
+
+typedef struct
+{
+    // Последняя задержка в тактах ядра.
+    uint32_t last;
+    // Минимальная задержка.
+    uint32_t min;
+    // Максимальная задержка.
+    uint32_t max;
+    // Сумма задержек (для среднего).
+    uint64_t sum;
+    // Количество замеров.
+    uint32_t count;
+    // Гистограмма с относительной шириной корзины не больше 1 / 2^LATENCY_SUB_BITS.
+    uint32_t buckets[LATENCY_BUCKETS];
+} UART_LatencyStats;
+
+/**
+ * Сбрасывает статистику задержек.
+ *
+ * \param stats Статистика.
+ */
+void HAL_UART_LatencyReset(UART_LatencyStats *stats);
+/**
+ * Учитывает одну задержку.
+ *
+ * \param stats Статистика.
+ * \param cycles Задержка в тактах ядра.
+ */
+void HAL_UART_LatencyRecord(UART_LatencyStats *stats, uint32_t cycles);
+/**
+ * Возвращает среднюю задержку. Вернёт 0, если замеров не было.
+ *
+ * \param stats Статистика.
+ */
+uint32_t HAL_UART_LatencyAverage(UART_LatencyStats *stats);
+/**
+ * Возвращает оценку перцентиля сверху (верхнюю границу корзины, но не больше максимума). Например, 99 для p99.
+ * Погрешность - не больше 12,5% (1 / 2^LATENCY_SUB_BITS). Вернёт 0, если замеров не было.
+ *
+ * \param stats Статистика.
+ * \param percent Перцентиль (1-100).
+ */
+uint32_t HAL_UART_LatencyPercentile(UART_LatencyStats *stats, unsigned percent);
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef _HAL_UART_LIN
+#define _HAL_UART_LIN
+
+#include <hal_uart.h>
+#include <hal_uart_latency.h>
+
+// Ответ на заголовок отправляет этот узел.
+#define LIN_PUBLISH 0
+// Ответ на заголовок принимает этот узел.
+#define LIN_SUBSCRIBE 1
+
+// Классическая контрольная сумма (LIN 1.x), только по данным.
+#define LIN_CHECKSUM_CLASSIC 0
+// Расширенная контрольная сумма (LIN 2.x), по PID и данным.
+#define LIN_CHECKSUM_ENHANCED 1
+
+// Кадр успешно обработан.
+#define LIN_OK 0
+// Истекло время ожидания.
+#define LIN_ERR_TIMEOUT 1
+// Неверная контрольная сумма ответа.
+#define LIN_ERR_CHECKSUM 2
+// Неверные биты чётности PID.
+#define LIN_ERR_PARITY 3
+// Принятый байт синхронизации не равен 0x55.
+#define LIN_ERR_SYNC 4
+// Прочитанное с шины значение не совпало с отправленным.
+#define LIN_ERR_BIT 5
+// Ответ не укладывается в отведённое окно и не был отправлен.
+#define LIN_ERR_LATE 6
+// Кадр заголовка потерян из-за переполнения приёмника (ORE).
+#define LIN_ERR_OVERRUN 7
+// Событий нет: слот ещё не наступил, заголовок не принят или PID не из таблицы.
+#define LIN_NONE 0xFF
+
+typedef struct
+{
+    // Идентификатор кадра (0-63).
+    uint8_t id;
+    // Одно из значений LIN_PUBLISH, LIN_SUBSCRIBE.
+    uint8_t direction;
+    // Длина данных (1-8).
+    uint8_t length;
+    // Одно из значений LIN_CHECKSUM_CLASSIC, LIN_CHECKSUM_ENHANCED.
+    uint8_t checksum;
+    // Данные ответа. Для LIN_SUBSCRIBE обновляются только при верной контрольной сумме.
+    uint8_t *data;
+    // Длительность слота в тактах ядра. Используется только в таблице расписания мастера.
+    uint32_t slotCycles;
+} LIN_Frame;
+
+typedef struct
+{
+    // Дескриптор устройства.
+    HAL_UART_Type *dev;
+    // Таблица расписания.
+    LIN_Frame *table;
+    // Длина таблицы.
+    unsigned count;
+    // Индекс следующего слота.
+    unsigned current;
+    // Момент начала следующего слота (mcycle).
+    uint32_t slotStart;
+    // Длительность бита в тактах ядра.
+    uint32_t bitCycles;
+    // true (по умолчанию), если трансивер возвращает отправленные данные на RX, как обычный LIN-трансивер.
+    bool echo;
+    // Задержка от конца PID до прихода ответа подчинённого.
+    UART_LatencyStats latency;
+    // Количество кадров, завершившихся ошибкой.
+    uint32_t errors;
+} LIN_Master;
+
+typedef struct
+{
+    // Дескриптор устройства.
+    HAL_UART_Type *dev;
+    // Таблица кадров, на которые отвечает или которые слушает узел.
+    LIN_Frame *table;
+    // Длина таблицы.
+    unsigned count;
+    // Длительность бита в тактах ядра.
+    uint32_t bitCycles;
+    // true (по умолчанию), если трансивер возвращает отправленные данные на RX, как обычный LIN-трансивер.
+    bool echo;
+    // Состояние приёма заголовка, изменяется в HAL_LIN_SlaveIrqHandler.
+    volatile uint8_t state;
+    // Результат приёма заголовка: LIN_OK или код ошибки.
+    volatile uint8_t header;
+    // Принятый PID.
+    volatile uint8_t pid;
+    // Момент обнаружения BREAK (mcycle).
+    volatile uint32_t breakStamp;
+    // Момент приёма PID (mcycle).
+    volatile uint32_t pidStamp;
+    // Задержка от приёма PID до начала отправки ответа.
+    UART_LatencyStats latency;
+    // Количество кадров, завершившихся ошибкой.
+    uint32_t errors;
+    // Количество ответов, пропущенных из-за выхода за окно ответа.
+    uint32_t late;
+    // Количество переполнений приёмника (ORE).
+    volatile uint32_t overruns;
+} LIN_Slave;
+
+/**
+ * Вычисляет защищённый идентификатор (PID) с битами чётности.
+ *
+ * \param id Идентификатор кадра (0-63).
+ */
+uint8_t HAL_LIN_Pid(uint8_t id);
+/**
+ * Вычисляет контрольную сумму кадра. Для идентификаторов 0x3C и 0x3D всегда используется классическая сумма.
+ *
+ * \param pid Защищённый идентификатор.
+ * \param data Данные.
+ * \param length Длина данных.
+ * \param type Одно из значений LIN_CHECKSUM_CLASSIC, LIN_CHECKSUM_ENHANCED.
+ */
+uint8_t HAL_LIN_Checksum(uint8_t pid, uint8_t *data, uint8_t length, uint8_t type);
+
+/**
+ * Включает устройство и готовит мастер к работе по таблице расписания. Первый слот начинается сразу.
+ * Предполагается, что ядро и USART тактируются одной частотой.
+ *
+ * \param master Состояние мастера.
+ * \param dev Дескриптор устройства.
+ * \param baseFreq Базовая частота (обычно 32_000_000).
+ * \param bod Скорость шины в бодах.
+ * \param table Таблица расписания.
+ * \param count Длина таблицы.
+ */
+void HAL_LIN_MasterInit(LIN_Master *master, HAL_UART_Type *dev, uint32_t baseFreq, uint32_t bod, LIN_Frame *table, unsigned count);
+/**
+ * Обрабатывает очередной слот, если его время наступило: отправляет BREAK, 0x55 и PID, затем отправляет
+ * или принимает ответ. Начало слотов отсчитывается от предыдущего, без накопления ошибки.
+ * Вернёт LIN_NONE, если слот ещё не наступил, иначе LIN_OK или код ошибки.
+ *
+ * \param master Состояние мастера.
+ */
+uint8_t HAL_LIN_MasterPoll(LIN_Master *master);
+
+/**
+ * Включает устройство для работы подчинённым узлом и разрешает прерывания LBD и RXNE: заголовок принимается
+ * в HAL_LIN_SlaveIrqHandler. Предполагается, что ядро и USART тактируются одной частотой.
+ *
+ * \param slave Состояние подчинённого.
+ * \param dev Дескриптор устройства.
+ * \param baseFreq Базовая частота (обычно 32_000_000).
+ * \param bod Скорость шины в бодах.
+ * \param table Таблица кадров.
+ * \param count Длина таблицы.
+ */
+void HAL_LIN_SlaveInit(LIN_Slave *slave, HAL_UART_Type *dev, uint32_t baseFreq, uint32_t bod, LIN_Frame *table, unsigned count);
+/**
+ * Обработчик прерывания. Должен вызываться из обработчика прерываний USART: принимает BREAK, 0x55 и PID
+ * и снимает метки их прихода. Пока ответ обрабатывается в HAL_LIN_SlavePoll, прерывание RXNE запрещено.
+ *
+ * \param slave Состояние подчинённого.
+ */
+void HAL_LIN_SlaveIrqHandler(LIN_Slave *slave);
+/**
+ * Обрабатывает ответ на принятый заголовок. Вызывается в основном цикле, не из прерывания:
+ * функция отправляет или принимает ответ целиком, вплоть до нескольких миллисекунд.
+ * Ответ отправляется, только если он успевает в окно ответа (40% номинальной длительности ответа),
+ * отсчитанное от метки прихода PID.
+ * Вернёт LIN_NONE, если обрабатывать нечего, иначе LIN_OK или код ошибки.
+ *
+ * \param slave Состояние подчинённого.
+ */
+uint8_t HAL_LIN_SlavePoll(LIN_Slave *slave);
+
+#endif
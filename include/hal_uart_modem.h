@@ -0,0 +1,104 @@
+#ifndef _HAL_UART_MODEM
+#define _HAL_UART_MODEM
+
+#include <hal_uart.h>
+#include <hal_uart_stream.h>
+
+// Линия DSR (модем готов).
+#define MODEM_DSR (1 << 0)
+// Линия RI (вызов). Сообщается импульсом, без ожидания устойчивого уровня.
+#define MODEM_RI (1 << 1)
+// Линия DCD (несущая).
+#define MODEM_DCD (1 << 2)
+
+typedef struct
+{
+    // Одно из значений MODEM_DSR, MODEM_RI, MODEM_DCD.
+    uint8_t line;
+    // Новый уровень линии. Для MODEM_RI всегда true.
+    bool active;
+    // Момент изменения (mcycle), до подавления дребезга.
+    uint32_t stamp;
+} UART_ModemEvent;
+
+/**
+ * Обработчик события модема. Вызывается из HAL_UART_ModemProcess, то есть, возможно, из прерывания.
+ *
+ * \param event Событие.
+ * \param context Указатель, переданный в UART_Modem.context.
+ */
+typedef void (*UART_ModemCallback)(UART_ModemEvent *event, void *context);
+
+typedef struct
+{
+    // Дескриптор устройства.
+    HAL_UART_Type *dev;
+    // Время, которое уровень DSR/DCD должен держаться, чтобы изменение было принято. Для RI - минимальный интервал между вызовами.
+    uint32_t debounceCycles;
+    // Устойчивое состояние линий (маска MODEM_*).
+    volatile uint8_t state;
+    // Линии, изменение которых ещё не подтвердилось.
+    volatile uint8_t pending;
+    // Моменты последних изменений DSR, RI, DCD.
+    uint32_t changedAt[3];
+    // Очередь событий. Может быть NULL.
+    UART_ModemEvent *queue;
+    // Длина очереди. Вмещает на 1 событие меньше.
+    unsigned size;
+    volatile unsigned head;
+    volatile unsigned tail;
+    // Количество событий, не поместившихся в очередь.
+    volatile uint32_t overruns;
+    // Обработчик событий. Может быть NULL.
+    UART_ModemCallback callback;
+    // Передаётся в обработчик.
+    void *context;
+    // Линии, без которых передача запрещена (например, MODEM_DSR | MODEM_DCD). 0 - без ограничений.
+    uint8_t gateMask;
+    // Поток, передача которого приостанавливается по gateMask. Может быть NULL.
+    UART_Stream *stream;
+    // true, если gateMask уже применён к потоку.
+    bool gateApplied;
+    // Длительность снятия DTR при пропадании несущей. 0 - DTR не трогается.
+    uint32_t hangupCycles;
+    // true, пока DTR снят для разрыва соединения.
+    volatile bool hangingUp;
+    // Момент окончания снятия DTR.
+    uint32_t hangupEnd;
+} UART_Modem;
+
+/**
+ * Готовит обработку линий модема и выставляет DTR. Поля callback, context, gateMask, stream и hangupCycles
+ * заполняются после вызова при необходимости. gateMask применяется к потоку при первом вызове HAL_UART_ModemProcess.
+ *
+ * \param modem Состояние модема.
+ * \param dev Дескриптор устройства.
+ * \param debounceCycles Время подавления дребезга в тактах ядра.
+ * \param queue Очередь событий. Может быть NULL. Не используется, если size меньше 2.
+ * \param size Длина очереди. Вмещает на 1 событие меньше.
+ */
+void HAL_UART_ModemInit(UART_Modem *modem, HAL_UART_Type *dev, uint32_t debounceCycles, UART_ModemEvent *queue, unsigned size);
+/**
+ * Обрабатывает флаги DSRIF/RIIF/DCDIF и подтверждает изменения, пережившие debounceCycles.
+ * Флаги защёлкиваются аппаратно, поэтому короткий импульс RI не теряется между вызовами.
+ * Вызывается из обработчика прерываний USART и из периодического таймера (для подтверждения по истечении времени),
+ * без опроса в основном цикле. Если ничего не ожидается, возвращается сразу.
+ *
+ * \param modem Состояние модема.
+ */
+void HAL_UART_ModemProcess(UART_Modem *modem);
+/**
+ * Забирает событие из очереди. Вернёт false, если событий нет.
+ *
+ * \param modem Состояние модема.
+ * \param event Событие.
+ */
+bool HAL_UART_ModemGetEvent(UART_Modem *modem, UART_ModemEvent *event);
+/**
+ * Проверяет, активны ли все линии из gateMask. Для отправки через HAL_UART_Send без потока.
+ *
+ * \param modem Состояние модема.
+ */
+bool HAL_UART_ModemCanSend(UART_Modem *modem);
+
+#endif
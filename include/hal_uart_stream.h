@@ -0,0 +1,118 @@
+#ifndef _HAL_UART_STREAM
+#define _HAL_UART_STREAM
+
+#include <hal_uart.h>
+
+// Управление потоком выключено.
+#define FLOW_NONE 0
+// Аппаратное управление потоком по линиям CTS/RTS.
+#define FLOW_HARDWARE 1
+// Программное управление потоком символами XON/XOFF.
+#define FLOW_XONXOFF 2
+
+#define XON 0x11
+#define XOFF 0x13
+
+// Передача приостановлена: собеседник снял CTS.
+#define STREAM_PAUSE_CTS (1 << 0)
+// Передача приостановлена: собеседник прислал XOFF.
+#define STREAM_PAUSE_XOFF (1 << 1)
+// Передача приостановлена внешним условием (например, пропаданием DSR/DCD).
+#define STREAM_PAUSE_MODEM (1 << 2)
+
+// HAL_UART_StreamFlush: передача так и не была возобновлена собеседником за CTS_TIMEOUT_TICKS.
+#define STREAM_FLUSH_PAUSED 2
+
+typedef struct
+{
+    // Дескриптор устройства.
+    HAL_UART_Type *dev;
+    // Одно из значений FLOW_NONE, FLOW_HARDWARE, FLOW_XONXOFF.
+    uint8_t flow;
+    // Кольцевой буфер передачи.
+    uint8_t *txBuf;
+    // Длина буфера передачи. Вмещает на 1 байт меньше.
+    unsigned txSize;
+    volatile unsigned txHead;
+    volatile unsigned txTail;
+    // Кольцевой буфер приёма.
+    uint8_t *rxBuf;
+    // Длина буфера приёма. Вмещает на 1 байт меньше.
+    unsigned rxSize;
+    volatile unsigned rxHead;
+    volatile unsigned rxTail;
+    // Заполнение буфера приёма, при котором собеседника просят остановиться.
+    unsigned highWater;
+    // Заполнение буфера приёма, при котором собеседнику разрешают продолжить.
+    unsigned lowWater;
+    // Маска причин приостановки передачи (STREAM_PAUSE_*). 0, если передавать можно.
+    volatile uint8_t paused;
+    // true, если собеседника попросили остановиться.
+    volatile bool throttled;
+    // XON/XOFF, ожидающий отправки вне очереди. 0, если нет.
+    volatile uint8_t control;
+    // Количество потерянных входящих байт.
+    volatile uint32_t overruns;
+} UART_Stream;
+
+/**
+ * Подключает буферы к включенному устройству и разрешает прерывания. Пороги по умолчанию - 3/4 и 1/4 буфера приёма.
+ * Для FLOW_HARDWARE включает CTSE/RTSE через HAL_UART_SetFlowControl (с перезапуском модуля) и прерывание по изменению CTS.
+ * Возвращает 1, если устройство не задано или управление потоком не удалось включить.
+ *
+ * \param stream Состояние потока.
+ * \param dev Дескриптор устройства.
+ * \param flow Одно из значений FLOW_NONE, FLOW_HARDWARE, FLOW_XONXOFF.
+ * \param txBuf Буфер передачи.
+ * \param txSize Длина буфера передачи.
+ * \param rxBuf Буфер приёма.
+ * \param rxSize Длина буфера приёма.
+ */
+uint8_t HAL_UART_StreamInit(UART_Stream *stream, HAL_UART_Type *dev, uint8_t flow, uint8_t *txBuf, unsigned txSize, uint8_t *rxBuf, unsigned rxSize);
+/**
+ * Обработчик прерывания. Должен вызываться из обработчика прерываний USART.
+ *
+ * \param stream Состояние потока.
+ */
+void HAL_UART_StreamIrqHandler(UART_Stream *stream);
+/**
+ * Ставит данные в очередь на отправку. Не блокирует. Вернёт количество поставленных в очередь байт.
+ *
+ * \param stream Состояние потока.
+ * \param buffer Буфер.
+ * \param count Длина буфера.
+ */
+unsigned HAL_UART_StreamWrite(UART_Stream *stream, uint8_t *buffer, unsigned count);
+/**
+ * Забирает принятые данные. Не блокирует. Вернёт количество прочитанных байт.
+ * При опустошении буфера до нижнего порога разрешает собеседнику продолжить передачу.
+ *
+ * \param stream Состояние потока.
+ * \param buffer Буфер.
+ * \param count Длина буфера.
+ */
+unsigned HAL_UART_StreamRead(UART_Stream *stream, uint8_t *buffer, unsigned count);
+/**
+ * Возвращает количество принятых, но ещё не прочитанных байт.
+ *
+ * \param stream Состояние потока.
+ */
+unsigned HAL_UART_StreamAvailable(UART_Stream *stream);
+/**
+ * Приостанавливает или возобновляет передачу по внешней причине. Может вызываться из прерывания.
+ *
+ * \param stream Состояние потока.
+ * \param reason Маска причины, обычно STREAM_PAUSE_MODEM.
+ * \param pause true для приостановки, false для возобновления.
+ */
+void HAL_UART_StreamSetPause(UART_Stream *stream, uint8_t reason, bool pause);
+/**
+ * Ждёт отправки всей очереди. Пока передача приостановлена, ожидание ограничено CTS_TIMEOUT_TICKS, а не TIMEOUT_TICKS.
+ * Возвращает 0 при успехе, 1, если передача встала без причины, STREAM_FLUSH_PAUSED, если передача так и осталась приостановленной.
+ * Очередь при ошибке не сбрасывается.
+ *
+ * \param stream Состояние потока.
+ */
+uint8_t HAL_UART_StreamFlush(UART_Stream *stream);
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef _HAL_UART_TIMESTAMP
+#define _HAL_UART_TIMESTAMP
+
+#include <hal_uart.h>
+#include <hal_uart_latency.h>
+
+// Метка времени у каждого кадра.
+#define STAMP_FRAME 0
+// Метка времени начала пакета (первого кадра после IDLE) у всех кадров пакета.
+#define STAMP_PACKET 1
+
+typedef struct
+{
+    // Кадр.
+    uint16_t data;
+    // true, если кадр первый после паузы на линии (IDLE).
+    bool packetStart;
+    // Момент прихода (mcycle) кадра или начала пакета.
+    uint32_t stamp;
+} UART_StampedFrame;
+
+typedef struct
+{
+    // Дескриптор устройства.
+    HAL_UART_Type *dev;
+    // Одно из значений STAMP_FRAME, STAMP_PACKET.
+    uint8_t mode;
+    // Кольцевой буфер принятых кадров.
+    UART_StampedFrame *buf;
+    // Длина буфера. Вмещает на 1 кадр меньше.
+    unsigned size;
+    volatile unsigned head;
+    volatile unsigned tail;
+    // true, если следующий кадр начинает пакет.
+    volatile bool idle;
+    // Метка начала текущего пакета.
+    volatile uint32_t packetStamp;
+    // Количество потерянных кадров.
+    volatile uint32_t overruns;
+    // Задержки между приходом и чтением.
+    UART_LatencyStats latency;
+} UART_StampedRx;
+
+/**
+ * Подключает буфер к включенному устройству и разрешает прерывания RXNE (и IDLE для STAMP_PACKET).
+ * Вернёт 1, если устройство или буфер не заданы либо size меньше 2; прерывания при этом не разрешаются.
+ *
+ * \param rx Состояние приёмника.
+ * \param dev Дескриптор устройства.
+ * \param mode Одно из значений STAMP_FRAME, STAMP_PACKET.
+ * \param buf Буфер кадров.
+ * \param size Длина буфера, не меньше 2.
+ */
+uint8_t HAL_UART_StampedInit(UART_StampedRx *rx, HAL_UART_Type *dev, uint8_t mode, UART_StampedFrame *buf, unsigned size);
+/**
+ * Обработчик прерывания. Должен вызываться из обработчика прерываний USART как можно раньше:
+ * метка снимается при входе и отстаёт от конца стоп-бита на время реакции на прерывание.
+ *
+ * \param rx Состояние приёмника.
+ */
+void HAL_UART_StampedIrqHandler(UART_StampedRx *rx);
+/**
+ * Забирает один кадр с меткой и учитывает задержку от прихода до чтения (в STAMP_PACKET - только для начала пакета).
+ * Вернёт false, если читать нечего.
+ *
+ * \param rx Состояние приёмника.
+ * \param out Кадр.
+ */
+bool HAL_UART_StampedRead(UART_StampedRx *rx, UART_StampedFrame *out);
+
+#endif
@@ -109,6 +109,18 @@ typedef union
     };
 } UART_FLAGS_Type;
 
+// Маски флагов для сброса записью 1 в FLAGS.
+#define UART_FLAGS_PE_M (1 << 0)
+#define UART_FLAGS_FE_M (1 << 1)
+#define UART_FLAGS_NF_M (1 << 2)
+#define UART_FLAGS_ORE_M (1 << 3)
+#define UART_FLAGS_IDLE_M (1 << 4)
+#define UART_FLAGS_TC_M (1 << 6)
+#define UART_FLAGS_LBDF_M (1 << 8)
+#define UART_FLAGS_CTSIF_M (1 << 9)
+// Все флаги ошибок приёма.
+#define UART_FLAGS_ERRORS_M (UART_FLAGS_PE_M | UART_FLAGS_FE_M | UART_FLAGS_NF_M | UART_FLAGS_ORE_M)
+
 typedef union
 {
     volatile uint32_t value;
@@ -126,6 +138,12 @@ typedef union
     };
 } UART_MODEM_Type;
 
+// Маски регистра MODEM. Флаги *IF сбрасываются записью 1.
+#define UART_MODEM_DSRIF_M (1 << 1)
+#define UART_MODEM_RIIF_M (1 << 2)
+#define UART_MODEM_DCDIF_M (1 << 3)
+#define UART_MODEM_DTR_M (1 << 8)
+
 typedef struct
 {
     volatile UART_CTRL1_Type CONTROL1;
@@ -69,6 +69,141 @@ void HAL_UART_Enable(HAL_UART_Type *dev, UART_InitData *init)
     }
 }
 
+uint8_t HAL_UART_EnableSync(HAL_UART_Type *dev, uint32_t baseFreq, uint32_t bod, uint8_t frameLength, UsartClockSetup clock)
+{
+    if (baseFreq == 0)
+        baseFreq = 32000000;
+    // приёмник работает с 16-кратной передискретизацией и в синхронном режиме
+    if (!dev || bod == 0 || baseFreq / bod < 16)
+        return 1;
+    UART_InitData init = {0};
+    init.baseFreq = baseFreq;
+    init.bod = bod;
+    init.dirs = TXRX;
+    init.frameLength = frameLength;
+    // старт- и стоп-биты в синхронном режиме остаются, но такты на них не выдаются
+    init.stopType = STOP_1;
+    init.clock = clock;
+    init.clock.enabled = 1;
+    HAL_UART_Enable(dev, &init);
+    return 0;
+}
+
+// Дожидается конца передачи и снимает UE: часть полей (делитель, формат кадра, CTSE/RTSE) пишется только так.
+static uint8_t uart_stop(HAL_UART_Type *dev)
+{
+    unsigned i = 0;
+    while (dev->CONTROL1.TE && !dev->FLAGS.TC)
+    {
+        if (++i >= TIMEOUT_TICKS)
+            return 1;
+    }
+    dev->CONTROL1.UE = 0;
+    return 0;
+}
+
+// Возвращает UE и дожидается готовности включенных приёмника и передатчика.
+static uint8_t uart_start(HAL_UART_Type *dev)
+{
+    bool rx = dev->CONTROL1.RE;
+    bool tx = dev->CONTROL1.TE;
+    dev->CONTROL1.UE = 1;
+    for (unsigned i = 0; (rx && !dev->FLAGS.REACK) || (tx && !dev->FLAGS.TEACK); i++)
+    {
+        if (i >= TIMEOUT_TICKS)
+            return 1;
+    }
+    return 0;
+}
+
+// Перезапускает модуль с новым делителем (и форматом кадра, если frame не NULL), не трогая остальные настройки.
+static uint8_t uart_set_divider(HAL_UART_Type *dev, uint32_t divider, UART_InitData *frame)
+{
+    if (uart_stop(dev))
+        return 1;
+    dev->DIVIDER = divider;
+    if (frame)
+    {
+        dev->CONTROL1.M0 = frame->frameLength & 1;
+        dev->CONTROL1.M1 = (frame->frameLength >> 1) & 1;
+        dev->CONTROL1.PCE = frame->parityBit & 1;
+        dev->CONTROL1.PS = (frame->parityBit >> 1) & 1;
+        dev->CONTROL2.STOP = frame->stopType & 1;
+    }
+    return uart_start(dev);
+}
+
+// Дожидается конца передачи и приёма, сохраняет принятый кадр и переключает модуль.
+static uint8_t uart_reconfigure(HAL_UART_Type *dev, UART_InitData *init, bool frame, int *pending)
+{
+    if (pending)
+        *pending = -1;
+    if (!dev)
+        return 1;
+    if (!init->bod)
+        return 1;
+    uint32_t baseFreq = init->baseFreq ? init->baseFreq : 32000000;
+    unsigned i = 0;
+    while (dev->CONTROL1.TE && !dev->FLAGS.TC)
+    {
+        if (++i >= TIMEOUT_TICKS)
+            return 1;
+    }
+    // не обрываем кадр, который принимается прямо сейчас
+    i = 0;
+    while (dev->CONTROL1.RE && dev->FLAGS.BUSY)
+    {
+        if (++i >= TIMEOUT_TICKS)
+            return 1;
+    }
+    // кадр принят целиком на старой скорости и верен
+    if (HAL_UART_HasInput(dev))
+    {
+        uint16_t val = HAL_UART_Read(dev);
+        if (pending)
+            *pending = val;
+    }
+    if (uart_set_divider(dev, baseFreq / init->bod, frame ? init : 0))
+        return 1;
+    // а вот пришедшее во время переключения принято неизвестно на какой скорости
+    while (HAL_UART_HasInput(dev))
+        (void)HAL_UART_Read(dev);
+    dev->FLAGS.value = UART_FLAGS_ERRORS_M;
+    return 0;
+}
+
+uint8_t HAL_UART_Reconfigure(HAL_UART_Type *dev, UART_InitData *init, int *pending)
+{
+    if (!init)
+    {
+        if (pending)
+            *pending = -1;
+        return 1;
+    }
+    return uart_reconfigure(dev, init, true, pending);
+}
+
+uint8_t HAL_UART_SetBaud(HAL_UART_Type *dev, uint32_t baseFreq, uint32_t bod, int *pending)
+{
+    UART_InitData init = {0};
+    init.baseFreq = baseFreq;
+    init.bod = bod;
+    return uart_reconfigure(dev, &init, false, pending);
+}
+
+uint8_t HAL_UART_SetFlowControl(HAL_UART_Type *dev, bool cts, bool rts)
+{
+    if (!dev)
+        return 1;
+    if (dev->CONTROL3.CTSE == cts && dev->CONTROL3.RTSE == rts)
+        return 0;
+    if (uart_stop(dev))
+        return 1;
+    dev->CONTROL3.CTSE = cts;
+    dev->CONTROL3.RTSE = rts;
+    return uart_start(dev);
+}
+
 void HAL_UART_Disable(HAL_UART_Type *dev)
 {
     if (!dev)
@@ -92,12 +227,20 @@ uint8_t HAL_UART_Send(HAL_UART_Type *dev, uint16_t val)
     if (!dev)
         return 1;
     dev->TXDATA = val;
+    unsigned stall = 0;
     for (unsigned i = 0; i < TIMEOUT_TICKS; i++)
     {
         if (dev->FLAGS.TC)
         {
             return 0;
         }
+        // собеседник снял CTS - ждём дольше, но не бесконечно (обрыв кабеля)
+        if (dev->CONTROL3.CTSE && !dev->FLAGS.CTS)
+        {
+            if (++stall >= CTS_TIMEOUT_TICKS)
+                return 1;
+            i = 0;
+        }
     }
     return 1;
 }
@@ -140,6 +283,98 @@ uint8_t HAL_UART_SendNT(HAL_UART_Type *dev, char *string)
     return 0;
 }
 
+// Потоковый обмен: в полёте не больше 2 кадров (TXDATA и сдвиговый регистр), чтобы приёмник не переполнялся.
+static uint8_t uart_transfer(HAL_UART_Type *dev, uint8_t *tx8, uint16_t *tx16, uint8_t *rx8, uint16_t *rx16, uint16_t dummy, unsigned count)
+{
+    if (!dev)
+        return 1;
+    // остатки предыдущего обмена
+    while (HAL_UART_HasInput(dev))
+        (void)HAL_UART_Read(dev);
+    unsigned sent = 0;
+    unsigned received = 0;
+    unsigned idle = 0;
+    while (received < count)
+    {
+        bool progress = false;
+        if (sent < count && sent - received < 2 && dev->FLAGS.TXE)
+        {
+            if (tx8)
+                dev->TXDATA = tx8[sent];
+            else if (tx16)
+                dev->TXDATA = tx16[sent];
+            else
+                dev->TXDATA = dummy;
+            sent++;
+            progress = true;
+        }
+        if (HAL_UART_HasInput(dev))
+        {
+            uint16_t val = HAL_UART_Read(dev);
+            if (rx8)
+                rx8[received] = (uint8_t)val;
+            else if (rx16)
+                rx16[received] = val;
+            received++;
+            progress = true;
+        }
+        if (progress)
+            idle = 0;
+        else if (++idle >= TIMEOUT_TICKS)
+            return 1;
+    }
+    return 0;
+}
+
+uint8_t HAL_UART_Transfer8(HAL_UART_Type *dev, uint8_t *tx, uint8_t *rx, unsigned count)
+{
+    return uart_transfer(dev, tx, 0, rx, 0, 0xFF, count);
+}
+
+uint8_t HAL_UART_Transfer16(HAL_UART_Type *dev, uint16_t *tx, uint16_t *rx, unsigned count)
+{
+    return uart_transfer(dev, 0, tx, 0, rx, 0x1FF, count);
+}
+
+void HAL_UART_SetDma(HAL_UART_Type *dev, bool tx, bool rx)
+{
+    if (!dev)
+        return;
+    dev->CONTROL3.DMAT = tx;
+    dev->CONTROL3.DMAR = rx;
+}
+
+uint8_t HAL_UART_SendBreak(HAL_UART_Type *dev)
+{
+    if (!dev)
+        return 1;
+    dev->CONTROL3.SBKRQ = 1;
+    // бит сбрасывается аппаратно после отправки
+    for (unsigned i = 0; i < TIMEOUT_TICKS; i++)
+    {
+        if (!dev->CONTROL3.SBKRQ)
+            return 0;
+    }
+    return 1;
+}
+
+uint8_t HAL_UART_SendBreakBits(HAL_UART_Type *dev, unsigned bits)
+{
+    if (!dev)
+        return 1;
+    // кадр 0x00 даёт старт-бит и биты данных в нуле; бит чётности может оказаться единицей
+    unsigned dataBits = dev->CONTROL1.M1 ? 7 : (dev->CONTROL1.M0 ? 9 : 8);
+    unsigned dominant = 1 + dataBits - dev->CONTROL1.PCE;
+    if (bits <= dominant)
+        return HAL_UART_Send(dev, 0);
+    uint32_t divider = dev->DIVIDER;
+    uint8_t status = uart_set_divider(dev, (divider * bits + dominant - 1) / dominant, 0);
+    if (!status)
+        status = HAL_UART_Send(dev, 0);
+    status |= uart_set_divider(dev, divider, 0);
+    return status;
+}
+
 uint16_t HAL_UART_Receive(HAL_UART_Type *dev)
 {
     // блокирующее получение
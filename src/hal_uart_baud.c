@@ -0,0 +1,214 @@
+#include <hal_uart_baud.h>
+
+// Предложение скорости: NEG_REQ, 4 байта скорости (младший первым), xor предыдущих байт.
+#define NEG_REQ 0xA5
+#define NEG_ACK 0x5A
+#define NEG_NAK 0xA6
+// Проверка прошла, остаёмся на новой скорости. Подчинённый подтверждает его NEG_ACK на новой скорости.
+#define NEG_COMMIT 0xC3
+// Ведущий получил NEG_ACK на NEG_COMMIT. Только после него подчинённый закрепляет новую скорость.
+#define NEG_CONFIRM 0x96
+// Сколько раз ведущий повторяет NEG_COMMIT, если ответ потерялся.
+#define NEG_COMMIT_RETRIES 3
+// Ведущий закончил перебор, остаёмся на начальной скорости.
+#define NEG_DONE 0x3C
+
+static uint8_t neg_pattern(unsigned i)
+{
+    // разные биты в соседних байтах, включая 0x00 и 0xFF
+    return (uint8_t)(i * 37 + 0x55);
+}
+
+static bool neg_receive(HAL_UART_Type *dev, unsigned timeout, uint8_t *out)
+{
+    uint8_t stat = 0;
+    *out = (uint8_t)HAL_UART_Receive_t(dev, timeout, &stat);
+    return stat == 0;
+}
+
+// Ждёт тишины на линии, чтобы собеседник успел отказаться от неудачной скорости.
+static void neg_drain(HAL_UART_Type *dev)
+{
+    uint8_t dummy;
+    while (neg_receive(dev, 2 * TIMEOUT_TICKS, &dummy))
+        ;
+    dev->FLAGS.value = UART_FLAGS_ERRORS_M;
+}
+
+static bool neg_supported(const uint32_t *rates, unsigned count, uint32_t bod)
+{
+    for (unsigned i = 0; i < count; i++)
+    {
+        if (rates[i] == bod)
+            return true;
+    }
+    return false;
+}
+
+// Отправляет буфер кадрами подряд, по TXE, без ожидания TC между ними.
+static bool neg_send_block(HAL_UART_Type *dev, uint8_t *buf, unsigned count)
+{
+    unsigned j;
+    for (unsigned i = 0; i < count; i++)
+    {
+        for (j = 0; !dev->FLAGS.TXE; j++)
+        {
+            if (j >= TIMEOUT_TICKS)
+                return false;
+        }
+        dev->TXDATA = buf[i];
+    }
+    for (j = 0; !dev->FLAGS.TC; j++)
+    {
+        if (j >= TIMEOUT_TICKS)
+            return false;
+    }
+    return true;
+}
+
+static bool neg_receive_block(HAL_UART_Type *dev, uint8_t *buf, unsigned count)
+{
+    for (unsigned i = 0; i < count; i++)
+    {
+        if (!neg_receive(dev, TIMEOUT_TICKS, &buf[i]))
+            return false;
+    }
+    return true;
+}
+
+// Возвращается на начальную скорость и ждёт, пока подчинённый тоже откажется от новой.
+static bool neg_master_fallback(HAL_UART_Type *dev, uint32_t baseFreq, uint32_t startBod)
+{
+    HAL_UART_SetBaud(dev, baseFreq, startBod, 0);
+    neg_drain(dev);
+    return false;
+}
+
+static bool neg_master_try(HAL_UART_Type *dev, uint32_t baseFreq, uint32_t startBod, uint32_t bod)
+{
+    uint8_t req[6] = {NEG_REQ, bod & 0xFF, (bod >> 8) & 0xFF, (bod >> 16) & 0xFF, (bod >> 24) & 0xFF, 0};
+    for (unsigned i = 0; i < 5; i++)
+        req[5] ^= req[i];
+    if (HAL_UART_Send8(dev, req, sizeof(req)))
+        return false;
+    uint8_t answer = 0;
+    if (!neg_receive(dev, TIMEOUT_TICKS, &answer) || answer != NEG_ACK)
+    {
+        // подтверждение могло потеряться, а подчинённый - переключиться
+        if (answer != NEG_NAK)
+            neg_drain(dev);
+        return false;
+    }
+
+    if (HAL_UART_SetBaud(dev, baseFreq, bod, 0))
+        return neg_master_fallback(dev, baseFreq, startBod);
+    uint32_t start = HAL_UART_Cycles();
+    while (HAL_UART_Cycles() - start < NEGOTIATE_SETTLE_CYCLES)
+        ;
+    // кадры подряд проверяют, что приёмник подчинённого успевает на этой скорости,
+    // его ответ подряд - что успевает наш
+    uint8_t burst[NEGOTIATE_BURST];
+    uint8_t echo[NEGOTIATE_BURST];
+    for (unsigned i = 0; i < NEGOTIATE_BURST; i++)
+        burst[i] = neg_pattern(i);
+    if (!neg_send_block(dev, burst, NEGOTIATE_BURST) || !neg_receive_block(dev, echo, NEGOTIATE_BURST))
+        return neg_master_fallback(dev, baseFreq, startBod);
+    if (dev->FLAGS.value & UART_FLAGS_ERRORS_M)
+        return neg_master_fallback(dev, baseFreq, startBod);
+    for (unsigned i = 0; i < NEGOTIATE_BURST; i++)
+    {
+        if (echo[i] != burst[i])
+            return neg_master_fallback(dev, baseFreq, startBod);
+    }
+    // без подтверждения на новой скорости считаем, что подчинённый вернулся на начальную:
+    // не получив NEG_CONFIRM, он и правда вернётся
+    bool acked = false;
+    for (unsigned r = 0; r < NEG_COMMIT_RETRIES && !acked; r++)
+    {
+        if (HAL_UART_Send(dev, NEG_COMMIT))
+            break;
+        acked = neg_receive(dev, TIMEOUT_TICKS, &answer) && answer == NEG_ACK;
+    }
+    if (!acked || HAL_UART_Send(dev, NEG_CONFIRM))
+        return neg_master_fallback(dev, baseFreq, startBod);
+    return true;
+}
+
+uint32_t HAL_UART_NegotiateMaster(HAL_UART_Type *dev, uint32_t baseFreq, uint32_t startBod, const uint32_t *rates, unsigned count)
+{
+    if (!dev || !rates)
+        return startBod;
+    for (unsigned i = 0; i < count; i++)
+    {
+        if (rates[i] == startBod)
+            break; // дальше только медленнее
+        if (neg_master_try(dev, baseFreq, startBod, rates[i]))
+            return rates[i];
+    }
+    HAL_UART_Send(dev, NEG_DONE);
+    return startBod;
+}
+
+// Обрабатывает одно предложение. Вернёт true и скорость в agreed, если скорость принята.
+static bool neg_slave_try(HAL_UART_Type *dev, uint32_t baseFreq, uint32_t startBod, const uint32_t *rates, unsigned count, uint32_t *agreed)
+{
+    uint8_t req[6] = {NEG_REQ};
+    uint8_t sum = NEG_REQ;
+    for (unsigned i = 1; i < 6; i++)
+    {
+        if (!neg_receive(dev, TIMEOUT_TICKS, &req[i]))
+            return false;
+        sum ^= req[i];
+    }
+    uint32_t bod = req[1] | (req[2] << 8) | ((uint32_t)req[3] << 16) | ((uint32_t)req[4] << 24);
+    if (sum != 0 || !neg_supported(rates, count, bod))
+    {
+        HAL_UART_Send(dev, NEG_NAK);
+        return false;
+    }
+    if (HAL_UART_Send(dev, NEG_ACK) || HAL_UART_SetBaud(dev, baseFreq, bod, 0))
+    {
+        HAL_UART_SetBaud(dev, baseFreq, startBod, 0);
+        return false;
+    }
+    // посылка принимается целиком и возвращается подряд; ошибки кадра ведущий увидит при сравнении
+    uint8_t burst[NEGOTIATE_BURST];
+    if (!neg_receive_block(dev, burst, NEGOTIATE_BURST) || !neg_send_block(dev, burst, NEGOTIATE_BURST))
+    {
+        HAL_UART_SetBaud(dev, baseFreq, startBod, 0);
+        return false;
+    }
+    // отвечаем на каждый повтор NEG_COMMIT; ждём дольше, чем ведущий ждёт ответа
+    uint8_t answer;
+    unsigned commits = 0;
+    while (neg_receive(dev, 2 * TIMEOUT_TICKS, &answer))
+    {
+        if (answer == NEG_CONFIRM && commits)
+        {
+            *agreed = bod;
+            return true;
+        }
+        if (answer != NEG_COMMIT || ++commits > NEG_COMMIT_RETRIES || HAL_UART_Send(dev, NEG_ACK))
+            break;
+    }
+    // тишина или мусор: ведущий не получил ответ и вернулся на начальную скорость
+    HAL_UART_SetBaud(dev, baseFreq, startBod, 0);
+    return false;
+}
+
+uint32_t HAL_UART_NegotiateSlave(HAL_UART_Type *dev, uint32_t baseFreq, uint32_t startBod, const uint32_t *rates, unsigned count)
+{
+    if (!dev || !rates)
+        return startBod;
+    while (1)
+    {
+        uint8_t next = (uint8_t)HAL_UART_Receive(dev);
+        if (next == NEG_DONE)
+            return startBod;
+        if (next != NEG_REQ)
+            continue;
+        uint32_t agreed;
+        if (neg_slave_try(dev, baseFreq, startBod, rates, count, &agreed))
+            return agreed;
+    }
+}
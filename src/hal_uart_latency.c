@@ -0,0 +1,78 @@
+#include <hal_uart_latency.h>
+
+// Корзина определяется старшим битом задержки и LATENCY_SUB_BITS битами за ним.
+static unsigned latency_bucket(uint32_t cycles)
+{
+    if (cycles < (1u << LATENCY_SUB_BITS))
+        return cycles;
+    unsigned msb = 0;
+    for (uint32_t v = cycles >> 1; v; v >>= 1)
+        msb++;
+    unsigned shift = msb - LATENCY_SUB_BITS;
+    return ((shift + 1) << LATENCY_SUB_BITS) + ((cycles >> shift) & ((1u << LATENCY_SUB_BITS) - 1));
+}
+
+// Наибольшая задержка, попадающая в корзину.
+static uint32_t latency_bound(unsigned bucket)
+{
+    if (bucket < (1u << LATENCY_SUB_BITS))
+        return bucket;
+    unsigned shift = (bucket >> LATENCY_SUB_BITS) - 1;
+    uint64_t lower = (uint64_t)((1u << LATENCY_SUB_BITS) + (bucket & ((1u << LATENCY_SUB_BITS) - 1))) << shift;
+    return (uint32_t)(lower + ((uint64_t)1 << shift) - 1);
+}
+
+void HAL_UART_LatencyReset(UART_LatencyStats *stats)
+{
+    if (!stats)
+        return;
+    stats->last = 0;
+    stats->min = 0;
+    stats->max = 0;
+    stats->sum = 0;
+    stats->count = 0;
+    for (unsigned i = 0; i < LATENCY_BUCKETS; i++)
+        stats->buckets[i] = 0;
+}
+
+void HAL_UART_LatencyRecord(UART_LatencyStats *stats, uint32_t cycles)
+{
+    if (!stats)
+        return;
+    stats->last = cycles;
+    if (stats->count == 0 || cycles < stats->min)
+        stats->min = cycles;
+    if (cycles > stats->max)
+        stats->max = cycles;
+    stats->sum += cycles;
+    stats->count++;
+    stats->buckets[latency_bucket(cycles)]++;
+}
+
+uint32_t HAL_UART_LatencyAverage(UART_LatencyStats *stats)
+{
+    if (!stats || stats->count == 0)
+        return 0;
+    return (uint32_t)(stats->sum / stats->count);
+}
+
+uint32_t HAL_UART_LatencyPercentile(UART_LatencyStats *stats, unsigned percent)
+{
+    if (!stats || stats->count == 0)
+        return 0;
+    if (percent > 100)
+        percent = 100;
+    // номер замера, до которого нужно дойти, с округлением вверх
+    uint64_t target = ((uint64_t)stats->count * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        seen += stats->buckets[i];
+        if (seen >= target)
+        {
+            uint32_t bound = latency_bound(i);
+            return bound < stats->max ? bound : stats->max;
+        }
+    }
+    return stats->max;
+}
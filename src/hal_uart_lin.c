@@ -0,0 +1,368 @@
+#include <hal_uart_lin.h>
+
+// Минимальная длительность BREAK по спецификации LIN.
+#define LIN_BREAK_BITS 13
+// Номинальная длительность заголовка в битах (BREAK 13 + разделитель 1 + 2 кадра по 10).
+#define LIN_HEADER_BITS 34
+
+// Состояния приёма заголовка подчинённым.
+// Ожидание BREAK, принятые кадры - чужой трафик на шине.
+#define LIN_SLAVE_IDLE 0
+// BREAK обнаружен, ожидается 0x55.
+#define LIN_SLAVE_SYNC 1
+// Ожидается PID.
+#define LIN_SLAVE_PID 2
+// Заголовок обработан, приёмником владеет HAL_LIN_SlavePoll.
+#define LIN_SLAVE_READY 3
+
+// true, если момент deadline уже наступил. Корректно при переполнении mcycle.
+static bool lin_expired(uint32_t deadline)
+{
+    return (int32_t)(HAL_UART_Cycles() - deadline) >= 0;
+}
+
+static uint8_t lin_receive(HAL_UART_Type *dev, uint32_t deadline, uint8_t *out)
+{
+    while (!HAL_UART_HasInput(dev))
+    {
+        if (lin_expired(deadline))
+            return LIN_ERR_TIMEOUT;
+    }
+    *out = (uint8_t)HAL_UART_Read(dev);
+    return LIN_OK;
+}
+
+static uint8_t lin_send(HAL_UART_Type *dev, bool echo, uint8_t val)
+{
+    if (HAL_UART_Send(dev, val))
+        return LIN_ERR_TIMEOUT;
+    if (!echo)
+        return LIN_OK;
+    // на однопроводной шине отправленный байт возвращается на RX
+    uint8_t stat = 0;
+    uint8_t back = (uint8_t)HAL_UART_Receive_t(dev, TIMEOUT_TICKS, &stat);
+    if (stat)
+        return LIN_ERR_TIMEOUT;
+    return back == val ? LIN_OK : LIN_ERR_BIT;
+}
+
+// Отбрасывает принятый кадр и сбрасывает флаги LBDF и ошибок приёма.
+static void lin_flush(HAL_UART_Type *dev)
+{
+    if (HAL_UART_HasInput(dev))
+        (void)HAL_UART_Read(dev);
+    dev->FLAGS.value = UART_FLAGS_LBDF_M | UART_FLAGS_ERRORS_M;
+}
+
+static LIN_Frame *lin_find(LIN_Frame *table, unsigned count, uint8_t id)
+{
+    for (unsigned i = 0; i < count; i++)
+    {
+        if (table[i].id == id)
+            return &table[i];
+    }
+    return 0;
+}
+
+// Номинальная длительность ответа в битах: данные и контрольная сумма по 10 бит.
+static uint32_t lin_response_bits(LIN_Frame *frame)
+{
+    return 10 * ((uint32_t)frame->length + 1);
+}
+
+uint8_t HAL_LIN_Pid(uint8_t id)
+{
+    id &= 0x3F;
+    uint8_t p0 = ((id >> 0) ^ (id >> 1) ^ (id >> 2) ^ (id >> 4)) & 1;
+    uint8_t p1 = ~((id >> 1) ^ (id >> 3) ^ (id >> 4) ^ (id >> 5)) & 1;
+    return id | (p0 << 6) | (p1 << 7);
+}
+
+uint8_t HAL_LIN_Checksum(uint8_t pid, uint8_t *data, uint8_t length, uint8_t type)
+{
+    uint8_t id = pid & 0x3F;
+    unsigned sum = 0;
+    // диагностические кадры всегда используют классическую сумму
+    if (type == LIN_CHECKSUM_ENHANCED && id != 0x3C && id != 0x3D)
+        sum = pid;
+    for (uint8_t i = 0; i < length; i++)
+    {
+        sum += data[i];
+        if (sum > 0xFF)
+            sum -= 0xFF; // перенос прибавляется к младшему разряду
+    }
+    return (uint8_t)~sum;
+}
+
+void HAL_LIN_MasterInit(LIN_Master *master, HAL_UART_Type *dev, uint32_t baseFreq, uint32_t bod, LIN_Frame *table, unsigned count)
+{
+    if (!master)
+        return;
+    if (baseFreq == 0)
+        baseFreq = 32000000;
+    master->dev = dev;
+    master->table = table;
+    master->count = count;
+    master->current = 0;
+    master->bitCycles = baseFreq / bod;
+    master->echo = true;
+    master->errors = 0;
+    HAL_UART_LatencyReset(&master->latency);
+    HAL_UART_EnableQuick(dev, baseFreq, bod);
+    master->slotStart = HAL_UART_Cycles();
+}
+
+static uint8_t lin_master_frame(LIN_Master *master, LIN_Frame *frame)
+{
+    HAL_UART_Type *dev = master->dev;
+    uint8_t pid = HAL_LIN_Pid(frame->id);
+    uint8_t status;
+
+    // заголовок
+    // SBKRQ даёт только ~10 бит, подчинённым нужно не меньше 13
+    if (HAL_UART_SendBreakBits(dev, LIN_BREAK_BITS))
+        return LIN_ERR_TIMEOUT;
+    // эхо BREAK принято на пониженной скорости и не проверяется
+    lin_flush(dev);
+    status = lin_send(dev, master->echo, 0x55);
+    if (status)
+        return status;
+    status = lin_send(dev, master->echo, pid);
+    if (status)
+        return status;
+    if (!master->echo && frame->direction == LIN_SUBSCRIBE)
+    {
+        // если эхо всё же есть, непрочитанный заголовок вызовет ORE и подменит первый байт ответа
+        unsigned i = 0;
+        while (!dev->FLAGS.TC)
+        {
+            if (++i >= TIMEOUT_TICKS)
+                return LIN_ERR_TIMEOUT;
+        }
+        lin_flush(dev);
+    }
+    uint32_t pidEnd = HAL_UART_Cycles();
+
+    if (frame->direction == LIN_PUBLISH)
+    {
+        for (uint8_t i = 0; i < frame->length; i++)
+        {
+            status = lin_send(dev, master->echo, frame->data[i]);
+            if (status)
+                return status;
+        }
+        return lin_send(dev, master->echo, HAL_LIN_Checksum(pid, frame->data, frame->length, frame->checksum));
+    }
+
+    // ответ подчинённого должен уложиться в 140% номинального времени
+    uint32_t deadline = pidEnd + (lin_response_bits(frame) * 14 / 10) * master->bitCycles;
+    uint8_t buf[9];
+    for (uint8_t i = 0; i <= frame->length; i++)
+    {
+        status = lin_receive(dev, deadline, &buf[i]);
+        if (status)
+            return status;
+        if (i == 0)
+        {
+            // RXNE выставляется после стоп-бита, начало байта на 10 бит раньше
+            uint32_t latency = HAL_UART_Cycles() - pidEnd;
+            uint32_t frameCycles = 10 * master->bitCycles;
+            HAL_UART_LatencyRecord(&master->latency, latency > frameCycles ? latency - frameCycles : 0);
+        }
+    }
+    if (buf[frame->length] != HAL_LIN_Checksum(pid, buf, frame->length, frame->checksum))
+        return LIN_ERR_CHECKSUM;
+    for (uint8_t i = 0; i < frame->length; i++)
+        frame->data[i] = buf[i];
+    return LIN_OK;
+}
+
+uint8_t HAL_LIN_MasterPoll(LIN_Master *master)
+{
+    if (!master || !master->dev || !master->table || master->count == 0)
+        return LIN_NONE;
+    if (!lin_expired(master->slotStart))
+        return LIN_NONE;
+    LIN_Frame *frame = &master->table[master->current];
+    // следующий слот отсчитывается от начала текущего, а не от конца обработки
+    master->slotStart += frame->slotCycles;
+    master->current++;
+    if (master->current >= master->count)
+        master->current = 0;
+    if (frame->length == 0 || frame->length > 8)
+        return LIN_NONE;
+    uint8_t status = lin_master_frame(master, frame);
+    if (status)
+        master->errors++;
+    return status;
+}
+
+void HAL_LIN_SlaveInit(LIN_Slave *slave, HAL_UART_Type *dev, uint32_t baseFreq, uint32_t bod, LIN_Frame *table, unsigned count)
+{
+    if (!slave)
+        return;
+    if (baseFreq == 0)
+        baseFreq = 32000000;
+    slave->dev = dev;
+    slave->table = table;
+    slave->count = count;
+    slave->bitCycles = baseFreq / bod;
+    slave->echo = true;
+    slave->state = LIN_SLAVE_IDLE;
+    slave->header = LIN_OK;
+    slave->pid = 0;
+    slave->breakStamp = 0;
+    slave->pidStamp = 0;
+    slave->errors = 0;
+    slave->late = 0;
+    slave->overruns = 0;
+    HAL_UART_LatencyReset(&slave->latency);
+    HAL_UART_EnableQuick(dev, baseFreq, bod);
+    if (!dev)
+        return;
+    lin_flush(dev);
+    dev->CONTROL2.LBDIE = 1;
+    dev->CONTROL1.RXNEIE = 1;
+}
+
+// Завершает приём заголовка и передаёт приёмник основному циклу.
+static void lin_slave_header(LIN_Slave *slave, uint8_t status)
+{
+    slave->header = status;
+    slave->state = LIN_SLAVE_READY;
+    slave->dev->CONTROL1.RXNEIE = 0;
+}
+
+void HAL_LIN_SlaveIrqHandler(LIN_Slave *slave)
+{
+    // метка снимается до любых обращений к регистрам
+    uint32_t now = HAL_UART_Cycles();
+    if (!slave || !slave->dev)
+        return;
+    HAL_UART_Type *dev = slave->dev;
+    uint32_t flags = dev->FLAGS.value;
+
+    // новый BREAK начинает заголовок заново, даже если предыдущий не закончен
+    if (flags & UART_FLAGS_LBDF_M)
+    {
+        dev->FLAGS.value = UART_FLAGS_LBDF_M;
+        slave->breakStamp = now;
+        slave->state = LIN_SLAVE_SYNC;
+    }
+    if (flags & UART_FLAGS_ORE_M)
+    {
+        dev->FLAGS.value = UART_FLAGS_ORE_M;
+        slave->overruns++;
+        if (slave->state == LIN_SLAVE_SYNC || slave->state == LIN_SLAVE_PID)
+            lin_slave_header(slave, LIN_ERR_OVERRUN);
+    }
+    if (slave->state == LIN_SLAVE_READY || !HAL_UART_HasInput(dev))
+        return;
+
+    uint8_t data = (uint8_t)HAL_UART_Read(dev);
+    dev->FLAGS.value = UART_FLAGS_PE_M | UART_FLAGS_FE_M | UART_FLAGS_NF_M;
+    if (slave->state == LIN_SLAVE_SYNC)
+    {
+        // кадр из нулей с ошибкой кадра - это сам BREAK
+        if (data == 0 && (flags & UART_FLAGS_FE_M))
+            return;
+        if (data != 0x55)
+            lin_slave_header(slave, LIN_ERR_SYNC);
+        else
+            slave->state = LIN_SLAVE_PID;
+    }
+    else if (slave->state == LIN_SLAVE_PID)
+    {
+        slave->pid = data;
+        slave->pidStamp = now;
+        lin_slave_header(slave, data == HAL_LIN_Pid(data) ? LIN_OK : LIN_ERR_PARITY);
+    }
+}
+
+static uint8_t lin_slave_response(LIN_Slave *slave, uint8_t pid, uint32_t pidSeen)
+{
+    HAL_UART_Type *dev = slave->dev;
+    uint8_t status;
+
+    LIN_Frame *frame = lin_find(slave->table, slave->count, pid & 0x3F);
+    if (!frame || frame->length == 0 || frame->length > 8)
+        return LIN_NONE;
+
+    if (frame->direction == LIN_PUBLISH)
+    {
+        uint8_t sum = HAL_LIN_Checksum(pid, frame->data, frame->length, frame->checksum);
+        uint32_t latency = HAL_UART_Cycles() - pidSeen;
+        // поздний ответ нарушит расписание мастера, лучше промолчать
+        if (latency > 4 * ((uint32_t)frame->length + 1) * slave->bitCycles)
+        {
+            slave->late++;
+            return LIN_ERR_LATE;
+        }
+        HAL_UART_LatencyRecord(&slave->latency, latency);
+        for (uint8_t i = 0; i < frame->length; i++)
+        {
+            status = lin_send(dev, slave->echo, frame->data[i]);
+            if (status)
+                return status;
+        }
+        return lin_send(dev, slave->echo, sum);
+    }
+
+    uint32_t deadline = pidSeen + (lin_response_bits(frame) * 14 / 10) * slave->bitCycles;
+    uint8_t buf[9];
+    for (uint8_t i = 0; i <= frame->length; i++)
+    {
+        status = lin_receive(dev, deadline, &buf[i]);
+        if (status)
+            return status;
+    }
+    if (buf[frame->length] != HAL_LIN_Checksum(pid, buf, frame->length, frame->checksum))
+        return LIN_ERR_CHECKSUM;
+    for (uint8_t i = 0; i < frame->length; i++)
+        frame->data[i] = buf[i];
+    return LIN_OK;
+}
+
+uint8_t HAL_LIN_SlavePoll(LIN_Slave *slave)
+{
+    if (!slave || !slave->dev)
+        return LIN_NONE;
+    HAL_UART_Type *dev = slave->dev;
+    uint8_t state = slave->state;
+    uint8_t status;
+
+    if (state == LIN_SLAVE_SYNC || state == LIN_SLAVE_PID)
+    {
+        // 0x55 и PID с запасом 40%
+        uint32_t deadline = slave->breakStamp + (LIN_HEADER_BITS * 14 / 10) * slave->bitCycles;
+        bool expired = false;
+        uint32_t irq = HAL_UART_IrqSave();
+        if ((slave->state == LIN_SLAVE_SYNC || slave->state == LIN_SLAVE_PID) && lin_expired(deadline))
+        {
+            slave->state = LIN_SLAVE_IDLE;
+            expired = true;
+        }
+        HAL_UART_IrqRestore(irq);
+        if (!expired)
+            return LIN_NONE;
+        slave->errors++;
+        return LIN_ERR_TIMEOUT;
+    }
+    if (state != LIN_SLAVE_READY)
+        return LIN_NONE;
+
+    status = slave->header;
+    if (status == LIN_OK)
+        status = lin_slave_response(slave, slave->pid, slave->pidStamp);
+
+    // приёмник возвращается обработчику прерывания; BREAK, пришедший во время ответа, не теряется
+    uint32_t irq = HAL_UART_IrqSave();
+    if (slave->state == LIN_SLAVE_READY)
+        slave->state = LIN_SLAVE_IDLE;
+    dev->CONTROL1.RXNEIE = 1;
+    HAL_UART_IrqRestore(irq);
+
+    if (status != LIN_OK && status != LIN_NONE)
+        slave->errors++;
+    return status;
+}
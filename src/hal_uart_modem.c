@@ -0,0 +1,164 @@
+#include <hal_uart_modem.h>
+
+// Индексы changedAt.
+#define DSR_INDEX 0
+#define RI_INDEX 1
+#define DCD_INDEX 2
+
+static uint8_t modem_levels(HAL_UART_Type *dev)
+{
+    uint8_t levels = 0;
+    if (dev->MODEM.DSR)
+        levels |= MODEM_DSR;
+    if (dev->MODEM.RI)
+        levels |= MODEM_RI;
+    if (dev->MODEM.DCD)
+        levels |= MODEM_DCD;
+    return levels;
+}
+
+static void modem_apply_gate(UART_Modem *modem)
+{
+    modem->gateApplied = true;
+    if (modem->stream)
+        HAL_UART_StreamSetPause(modem->stream, STREAM_PAUSE_MODEM, !HAL_UART_ModemCanSend(modem));
+}
+
+static void modem_emit(UART_Modem *modem, uint8_t line, bool active, uint32_t stamp)
+{
+    UART_ModemEvent event;
+    event.line = line;
+    event.active = active;
+    event.stamp = stamp;
+    if (modem->queue)
+    {
+        unsigned next = (modem->head + 1) % modem->size;
+        if (next == modem->tail)
+        {
+            modem->overruns++;
+        }
+        else
+        {
+            modem->queue[modem->head] = event;
+            modem->head = next;
+        }
+    }
+    if (modem->callback)
+        modem->callback(&event, modem->context);
+}
+
+// Подтверждает изменение уровня DSR/DCD, если он продержался debounceCycles.
+static void modem_settle(UART_Modem *modem, uint8_t line, unsigned index, uint32_t now)
+{
+    if (!(modem->pending & line))
+        return;
+    if (now - modem->changedAt[index] < modem->debounceCycles)
+        return;
+    modem->pending &= ~line;
+    uint8_t level = modem_levels(modem->dev) & line;
+    if (level == (modem->state & line))
+        return; // дребезг вернулся к прежнему уровню
+    modem->state ^= line;
+    modem_apply_gate(modem);
+    if (line == MODEM_DCD && !level && modem->hangupCycles)
+    {
+        // несущая пропала - кладём трубку
+        HAL_UART_SetDtr(modem->dev, false);
+        modem->hangingUp = true;
+        modem->hangupEnd = now + modem->hangupCycles;
+    }
+    modem_emit(modem, line, level != 0, modem->changedAt[index]);
+}
+
+void HAL_UART_ModemInit(UART_Modem *modem, HAL_UART_Type *dev, uint32_t debounceCycles, UART_ModemEvent *queue, unsigned size)
+{
+    if (!modem)
+        return;
+    uint32_t now = HAL_UART_Cycles();
+    modem->dev = dev;
+    modem->debounceCycles = debounceCycles;
+    modem->state = 0;
+    modem->pending = 0;
+    for (unsigned i = 0; i < 3; i++)
+        modem->changedAt[i] = now - debounceCycles;
+    // очередь на 1 элемент не вмещает ни одного события, а при size == 0 остаток от деления не определён
+    modem->queue = size >= 2 ? queue : 0;
+    modem->size = size;
+    modem->head = 0;
+    modem->tail = 0;
+    modem->overruns = 0;
+    modem->callback = 0;
+    modem->context = 0;
+    modem->gateMask = 0;
+    modem->stream = 0;
+    modem->gateApplied = false;
+    modem->hangupCycles = 0;
+    modem->hangingUp = false;
+    modem->hangupEnd = 0;
+    if (!dev)
+        return;
+    dev->MODEM.value = UART_MODEM_DSRIF_M | UART_MODEM_RIIF_M | UART_MODEM_DCDIF_M | UART_MODEM_DTR_M;
+    modem->state = modem_levels(dev) & (MODEM_DSR | MODEM_DCD);
+}
+
+void HAL_UART_ModemProcess(UART_Modem *modem)
+{
+    if (!modem || !modem->dev)
+        return;
+    HAL_UART_Type *dev = modem->dev;
+    uint32_t reg = dev->MODEM.value;
+    uint32_t flags = reg & (UART_MODEM_DSRIF_M | UART_MODEM_RIIF_M | UART_MODEM_DCDIF_M);
+    if (!flags && !modem->pending && !modem->hangingUp && modem->gateApplied)
+        return;
+    uint32_t now = HAL_UART_Cycles();
+    if (!modem->gateApplied)
+        modem_apply_gate(modem);
+
+    if (flags)
+    {
+        dev->MODEM.value = flags | (reg & UART_MODEM_DTR_M);
+        if (flags & UART_MODEM_DSRIF_M)
+        {
+            modem->pending |= MODEM_DSR;
+            modem->changedAt[DSR_INDEX] = now;
+        }
+        if (flags & UART_MODEM_DCDIF_M)
+        {
+            modem->pending |= MODEM_DCD;
+            modem->changedAt[DCD_INDEX] = now;
+        }
+        // фронт и спад одного звонка дают два флага, второй отсекается интервалом
+        if ((flags & UART_MODEM_RIIF_M) && now - modem->changedAt[RI_INDEX] >= modem->debounceCycles)
+        {
+            modem->changedAt[RI_INDEX] = now;
+            modem_emit(modem, MODEM_RI, true, now);
+        }
+    }
+
+    modem_settle(modem, MODEM_DSR, DSR_INDEX, now);
+    modem_settle(modem, MODEM_DCD, DCD_INDEX, now);
+
+    if (modem->hangingUp && (int32_t)(now - modem->hangupEnd) >= 0)
+    {
+        modem->hangingUp = false;
+        HAL_UART_SetDtr(dev, true);
+    }
+}
+
+bool HAL_UART_ModemGetEvent(UART_Modem *modem, UART_ModemEvent *event)
+{
+    if (!modem || !modem->queue || !event)
+        return false;
+    if (modem->tail == modem->head)
+        return false;
+    *event = modem->queue[modem->tail];
+    modem->tail = (modem->tail + 1) % modem->size;
+    return true;
+}
+
+bool HAL_UART_ModemCanSend(UART_Modem *modem)
+{
+    if (!modem)
+        return false;
+    return (modem->state & modem->gateMask) == modem->gateMask;
+}
@@ -0,0 +1,234 @@
+#include <hal_uart_stream.h>
+
+static unsigned stream_fill(unsigned head, unsigned tail, unsigned size)
+{
+    return head >= tail ? head - tail : size - tail + head;
+}
+
+// Передатчик включается, если есть что отправить и собеседник готов (XON/XOFF отправляются всегда).
+// CONTROL1 меняет и обработчик прерывания, поэтому чтение-изменение-запись идёт с запрещёнными прерываниями.
+static void stream_kick_tx(UART_Stream *stream)
+{
+    uint32_t irq = HAL_UART_IrqSave();
+    if (stream->control || (!stream->paused && stream->txHead != stream->txTail))
+        stream->dev->CONTROL1.TXEIE = 1;
+    HAL_UART_IrqRestore(irq);
+}
+
+uint8_t HAL_UART_StreamInit(UART_Stream *stream, HAL_UART_Type *dev, uint8_t flow, uint8_t *txBuf, unsigned txSize, uint8_t *rxBuf, unsigned rxSize)
+{
+    if (!stream)
+        return 1;
+    stream->dev = dev;
+    stream->flow = flow;
+    stream->txBuf = txBuf;
+    stream->txSize = txSize;
+    stream->txHead = 0;
+    stream->txTail = 0;
+    stream->rxBuf = rxBuf;
+    stream->rxSize = rxSize;
+    stream->rxHead = 0;
+    stream->rxTail = 0;
+    stream->highWater = rxSize * 3 / 4;
+    stream->lowWater = rxSize / 4;
+    stream->paused = 0;
+    stream->throttled = false;
+    stream->control = 0;
+    stream->overruns = 0;
+    if (!dev)
+        return 1;
+    if (flow == FLOW_HARDWARE)
+    {
+        if (HAL_UART_SetFlowControl(dev, true, true))
+            return 1;
+        if (!dev->FLAGS.CTS)
+            stream->paused = STREAM_PAUSE_CTS;
+        dev->FLAGS.value = UART_FLAGS_CTSIF_M;
+        dev->CONTROL3.CTSIE = 1;
+    }
+    dev->CONTROL1.RXNEIE = 1;
+    return 0;
+}
+
+void HAL_UART_StreamIrqHandler(UART_Stream *stream)
+{
+    if (!stream || !stream->dev)
+        return;
+    HAL_UART_Type *dev = stream->dev;
+
+    if (dev->FLAGS.CTSIF)
+    {
+        dev->FLAGS.value = UART_FLAGS_CTSIF_M;
+        if (dev->FLAGS.CTS)
+            stream->paused &= ~STREAM_PAUSE_CTS;
+        else
+            stream->paused |= STREAM_PAUSE_CTS;
+    }
+
+    if (dev->FLAGS.ORE)
+    {
+        dev->FLAGS.value = UART_FLAGS_ORE_M;
+        stream->overruns++;
+    }
+
+    if (dev->CONTROL1.RXNEIE && HAL_UART_HasInput(dev))
+    {
+        unsigned fill = stream_fill(stream->rxHead, stream->rxTail, stream->rxSize);
+        if (stream->flow == FLOW_HARDWARE && fill >= stream->highWater)
+        {
+            // кадр остаётся в RXDATA, пока он не прочитан, RTS снят аппаратно
+            dev->CONTROL1.RXNEIE = 0;
+            stream->throttled = true;
+        }
+        else
+        {
+            uint8_t val = (uint8_t)HAL_UART_Read(dev);
+            if (stream->flow == FLOW_XONXOFF && (val == XON || val == XOFF))
+            {
+                if (val == XOFF)
+                    stream->paused |= STREAM_PAUSE_XOFF;
+                else
+                    stream->paused &= ~STREAM_PAUSE_XOFF;
+            }
+            else
+            {
+                unsigned next = (stream->rxHead + 1) % stream->rxSize;
+                if (next == stream->rxTail)
+                {
+                    stream->overruns++;
+                }
+                else
+                {
+                    stream->rxBuf[stream->rxHead] = val;
+                    stream->rxHead = next;
+                    fill++;
+                }
+                if (stream->flow == FLOW_XONXOFF && !stream->throttled && fill >= stream->highWater)
+                {
+                    stream->throttled = true;
+                    stream->control = XOFF;
+                }
+            }
+        }
+    }
+
+    if (dev->CONTROL1.TXEIE && dev->FLAGS.TXE)
+    {
+        if (stream->control)
+        {
+            dev->TXDATA = stream->control;
+            stream->control = 0;
+        }
+        else if (!stream->paused && stream->txHead != stream->txTail)
+        {
+            dev->TXDATA = stream->txBuf[stream->txTail];
+            stream->txTail = (stream->txTail + 1) % stream->txSize;
+        }
+        else
+        {
+            // до следующей записи в очередь или возобновления
+            dev->CONTROL1.TXEIE = 0;
+        }
+    }
+    stream_kick_tx(stream);
+}
+
+unsigned HAL_UART_StreamWrite(UART_Stream *stream, uint8_t *buffer, unsigned count)
+{
+    if (!stream || !stream->dev || !buffer)
+        return 0;
+    unsigned i = 0;
+    while (i < count)
+    {
+        unsigned next = (stream->txHead + 1) % stream->txSize;
+        if (next == stream->txTail)
+            break; // очередь заполнена
+        stream->txBuf[stream->txHead] = buffer[i];
+        stream->txHead = next;
+        i++;
+    }
+    stream_kick_tx(stream);
+    return i;
+}
+
+unsigned HAL_UART_StreamRead(UART_Stream *stream, uint8_t *buffer, unsigned count)
+{
+    if (!stream || !stream->dev || !buffer)
+        return 0;
+    unsigned i = 0;
+    while (i < count && stream->rxTail != stream->rxHead)
+    {
+        buffer[i] = stream->rxBuf[stream->rxTail];
+        stream->rxTail = (stream->rxTail + 1) % stream->rxSize;
+        i++;
+    }
+    if (stream->throttled && HAL_UART_StreamAvailable(stream) <= stream->lowWater)
+    {
+        uint32_t irq = HAL_UART_IrqSave();
+        stream->throttled = false;
+        if (stream->flow == FLOW_HARDWARE)
+        {
+            // прерывание сразу заберёт задержанный кадр, RTS вернётся аппаратно
+            stream->dev->CONTROL1.RXNEIE = 1;
+        }
+        else if (stream->flow == FLOW_XONXOFF)
+        {
+            stream->control = XON;
+        }
+        HAL_UART_IrqRestore(irq);
+        stream_kick_tx(stream);
+    }
+    return i;
+}
+
+unsigned HAL_UART_StreamAvailable(UART_Stream *stream)
+{
+    if (!stream)
+        return 0;
+    return stream_fill(stream->rxHead, stream->rxTail, stream->rxSize);
+}
+
+void HAL_UART_StreamSetPause(UART_Stream *stream, uint8_t reason, bool pause)
+{
+    if (!stream || !stream->dev)
+        return;
+    // paused меняет и обработчик прерывания по CTS/XOFF
+    uint32_t irq = HAL_UART_IrqSave();
+    if (pause)
+        stream->paused |= reason;
+    else
+        stream->paused &= ~reason;
+    HAL_UART_IrqRestore(irq);
+    stream_kick_tx(stream);
+}
+
+uint8_t HAL_UART_StreamFlush(UART_Stream *stream)
+{
+    if (!stream || !stream->dev)
+        return 1;
+    unsigned i = 0;
+    unsigned stall = 0;
+    unsigned tail = stream->txTail;
+    while (stream->txHead != stream->txTail || stream->control || !stream->dev->FLAGS.TC)
+    {
+        if (tail != stream->txTail)
+        {
+            // очередь движется, это не ошибка
+            tail = stream->txTail;
+            i = 0;
+            stall = 0;
+            continue;
+        }
+        if (stream->paused)
+        {
+            // собеседник не готов: ждём дольше, но при обрыве связи возвращаем отдельный статус
+            if (++stall >= CTS_TIMEOUT_TICKS)
+                return STREAM_FLUSH_PAUSED;
+            i = 0;
+            continue;
+        }
+        if (++i >= TIMEOUT_TICKS)
+            return 1;
+    }
+    return 0;
+}
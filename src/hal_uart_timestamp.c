@@ -0,0 +1,83 @@
+#include <hal_uart_timestamp.h>
+
+uint8_t HAL_UART_StampedInit(UART_StampedRx *rx, HAL_UART_Type *dev, uint8_t mode, UART_StampedFrame *buf, unsigned size)
+{
+    if (!rx)
+        return 1;
+    // без буфера хотя бы на 1 кадр обработчик прерывания не сможет ничего сохранить
+    if (!buf || size < 2)
+        dev = 0;
+    rx->dev = dev;
+    rx->mode = mode;
+    rx->buf = buf;
+    rx->size = size;
+    rx->head = 0;
+    rx->tail = 0;
+    rx->idle = true;
+    rx->packetStamp = 0;
+    rx->overruns = 0;
+    HAL_UART_LatencyReset(&rx->latency);
+    if (!dev)
+        return 1;
+    dev->FLAGS.value = UART_FLAGS_IDLE_M;
+    if (mode == STAMP_PACKET)
+        dev->CONTROL1.IDLEIE = 1;
+    dev->CONTROL1.RXNEIE = 1;
+    return 0;
+}
+
+void HAL_UART_StampedIrqHandler(UART_StampedRx *rx)
+{
+    // метка снимается до любых обращений к регистрам
+    uint32_t now = HAL_UART_Cycles();
+    if (!rx || !rx->dev)
+        return;
+    HAL_UART_Type *dev = rx->dev;
+
+    if (dev->FLAGS.ORE)
+    {
+        dev->FLAGS.value = UART_FLAGS_ORE_M;
+        rx->overruns++;
+    }
+
+    if (HAL_UART_HasInput(dev))
+    {
+        UART_StampedFrame frame;
+        frame.data = (uint16_t)HAL_UART_Read(dev);
+        frame.packetStart = rx->idle;
+        if (rx->idle)
+            rx->packetStamp = now;
+        rx->idle = false;
+        frame.stamp = rx->mode == STAMP_PACKET ? rx->packetStamp : now;
+        unsigned next = (rx->head + 1) % rx->size;
+        if (next == rx->tail)
+        {
+            rx->overruns++;
+        }
+        else
+        {
+            rx->buf[rx->head] = frame;
+            rx->head = next;
+        }
+    }
+
+    // IDLE проверяется после RXNE: если оба флага подняты, кадр относится к закончившемуся пакету
+    if (dev->FLAGS.IDLE)
+    {
+        dev->FLAGS.value = UART_FLAGS_IDLE_M;
+        rx->idle = true;
+    }
+}
+
+bool HAL_UART_StampedRead(UART_StampedRx *rx, UART_StampedFrame *out)
+{
+    if (!rx || !out)
+        return false;
+    if (rx->tail == rx->head)
+        return false;
+    *out = rx->buf[rx->tail];
+    rx->tail = (rx->tail + 1) % rx->size;
+    if (rx->mode == STAMP_FRAME || out->packetStart)
+        HAL_UART_LatencyRecord(&rx->latency, HAL_UART_Cycles() - out->stamp);
+    return true;
+}
@@ -2,11 +2,62 @@
 #include <xprintf.h>
 #include <power_manager.h>
 
+#ifdef BENCH_SYNC
+// Приёмник работает с 16-кратной передискретизацией в обоих режимах, быстрее baseFreq / 16 он не принимает.
+#define BENCH_MAX_BOD 2000000
+
+/**
+ * Замеряет обмен 256 байт через UART_P1 во внутренней петле (LBM) одним и тем же потоковым циклом
+ * HAL_UART_Transfer8, асинхронно или синхронно. Результат в тактах выводится в UART_P0.
+ */
+static void benchmark_transfer(char *name, uint32_t bod, bool sync)
+{
+    uint8_t tx[256];
+    uint8_t rx[256];
+    for (unsigned i = 0; i < sizeof(tx); i++)
+        tx[i] = i;
+
+    HAL_UART_SendNT(UART_P0, name);
+    HAL_UART_SendNT(UART_P0, ": ");
+    if (sync)
+    {
+        UsartClockSetup clock = {0};
+        if (HAL_UART_EnableSync(UART_P1, 0, bod, FRAME_8BITS, clock))
+        {
+            HAL_UART_SendNT(UART_P0, "unsupported\n");
+            return;
+        }
+    }
+    else
+    {
+        HAL_UART_EnableQuick(UART_P1, 0, bod);
+    }
+    UART_P1->CONTROL2.LBM = 1;
+    uint32_t start = HAL_UART_Cycles();
+    uint8_t status = HAL_UART_Transfer8(UART_P1, tx, rx, sizeof(tx));
+    uint32_t cycles = HAL_UART_Cycles() - start;
+    for (unsigned i = 0; i < sizeof(tx); i++)
+    {
+        if (rx[i] != tx[i])
+            status = 1;
+    }
+
+    HAL_UART_SendAsciiInt(UART_P0, cycles);
+    HAL_UART_SendNT(UART_P0, status ? " cycles, FAILED\n" : " cycles\n");
+}
+#endif
+
 int main()
 {
     PM->CLK_APB_M_SET |= PM_CLOCK_PAD_CONFIG_M | PM_CLOCK_WU_M | PM_CLOCK_PM_M;
     PM->CLK_APB_P_SET |= PM_CLOCK_UART_0_M;
     HAL_UART_EnableQuick(UART_P0, 0, 115200);
+#ifdef BENCH_SYNC
+    PM->CLK_APB_P_SET |= PM_CLOCK_UART_1_M;
+    benchmark_transfer("async 2M", BENCH_MAX_BOD, false);
+    benchmark_transfer("sync 2M", BENCH_MAX_BOD, true);
+    HAL_UART_Disable(UART_P1);
+#endif
     uint8_t buf8[] = {'a', 's', 'd', '\n'};
     unsigned i = 0;
     while (1)